@@ -0,0 +1,208 @@
+#!/bin/sh
+#
+# Scaling benchmark of the pgtools on synthetic geodesic datasets.
+#
+# Generates the datasets once with sandbox/BenchGenerate, then runs each
+# pgtool in the blocking, nonblocking (--nbio), and process group (--groups)
+# variants it implements at each process count and appends one CSV line per
+# run:
+#
+#   tool,variant,np,dataset,input_bytes,output_bytes,seconds,
+#   throughput_MBps,io_MBps,maxrss_kB,status
+#
+# throughput_MBps is the input bytes over the wall time, io_MBps counts the
+# output as well, and maxrss_kB is the largest resident set high-water mark
+# of any process (empty unless GNU time is installed as /usr/bin/time).
+# status is the exit status of the tool.  Datasets are deterministic, so
+# results for the same options and build may be compared across revisions.
+#
+# Usually run as "make bench BENCH_ARGS=...".  Environment:
+#   MPIRUN   how to launch MPI programs (default: mpirun)
+#   BINDIR   directory holding the pgtools (default: .)
+#   GENDIR   directory holding BenchGenerate (default: $BINDIR/sandbox)
+
+usage()
+{
+    cat <<EOF
+usage: bench.sh [-g generate-args] [-n nprocs] [-t tools] [-s nfiles]
+                [-o output.csv] [-w workdir] [-k]
+  -g  arguments to BenchGenerate (default: "$generate_args")
+  -n  process counts (default: "$nprocs")
+  -t  tools (default: "$tools")
+  -s  number of files the records are split across (default: $nfiles)
+  -o  append results to this file (default: $output)
+  -w  directory for the datasets and outputs (default: $workdir)
+  -k  keep the datasets
+EOF
+}
+
+MPIRUN=${MPIRUN:-mpirun}
+BINDIR=${BINDIR:-.}
+GENDIR=${GENDIR:-$BINDIR/sandbox}
+
+generate_args="-c 40962 -l 26 -r 8 -t float -f 0.1 -v 4"
+nprocs="1 2 4"
+tools="pgra pgwa pgsub pgrcat pgecat pgea pgbo"
+nfiles=4
+output=bench.csv
+workdir=bench.d
+keep=no
+
+while getopts "g:n:t:s:o:w:kh" opt
+do
+    case $opt in
+        g) generate_args=$OPTARG ;;
+        n) nprocs=$OPTARG ;;
+        t) tools=$OPTARG ;;
+        s) nfiles=$OPTARG ;;
+        o) output=$OPTARG ;;
+        w) workdir=$OPTARG ;;
+        k) keep=yes ;;
+        *) usage; exit 1 ;;
+    esac
+done
+
+if /usr/bin/time -f %M true >/dev/null 2>&1
+then
+    TIME=/usr/bin/time
+else
+    TIME=
+fi
+
+# seconds since the epoch, with nanoseconds if date supports them
+now()
+{
+    t=`date +%s.%N`
+    case $t in
+        *N) date +%s ;;
+        *) echo $t ;;
+    esac
+}
+
+# total size in bytes of those arguments which are files
+bytes()
+{
+    total=0
+    for f in "$@"
+    do
+        if test -f "$f"
+        then
+            total=`expr $total + \`wc -c <"$f"\``
+        fi
+    done
+    echo $total
+}
+
+# run TOOL VARIANT NP OUTPUT ARGS...
+run()
+{
+    tool=$1 variant=$2 np=$3 out=$4
+    shift 4
+    case $variant in
+        blocking) flags= ;;
+        nbio) flags=--nbio ;;
+        groups) flags="--groups 2" ;;
+    esac
+    rm -f "$out" "$workdir/maxrss"
+    start=`now`
+    if test -n "$TIME"
+    then
+        $MPIRUN -np $np $TIME -a -o "$workdir/maxrss" -f %M \
+            "$BINDIR/$tool" $flags -O "$@" "$out" >"$workdir/$tool.log" 2>&1
+    else
+        $MPIRUN -np $np "$BINDIR/$tool" $flags -O "$@" "$out" \
+            >"$workdir/$tool.log" 2>&1
+    fi
+    status=$?
+    end=`now`
+    maxrss=
+    if test -s "$workdir/maxrss"
+    then
+        maxrss=`sort -n "$workdir/maxrss" | tail -n 1`
+    fi
+    input_bytes=`bytes "$@"`
+    output_bytes=`bytes "$out"`
+    awk -v tool=$tool -v variant=$variant -v np=$np \
+        -v dataset="$generate_args" -v inb=$input_bytes -v outb=$output_bytes \
+        -v start=$start -v end=$end -v maxrss="$maxrss" -v status=$status \
+        'BEGIN {
+            s = end - start
+            if (s <= 0) s = 1e-9
+            printf "%s,%s,%d,\"%s\",%d,%d,%.3f,%.3f,%.3f,%s,%d\n", tool,
+                variant, np, dataset, inb, outb, s, inb/s/1e6, (inb+outb)/s/1e6,
+                maxrss, status
+        }' | tee -a "$output"
+    rm -f "$out"
+}
+
+mkdir -p "$workdir" || exit 1
+first_np=`echo $nprocs | awk '{print $1}'`
+
+# the whole dataset in one file, and its records split across nfiles files
+single="$workdir/bench.nc"
+split=
+i=0
+while test $i -lt $nfiles
+do
+    split="$split $workdir/bench_split_`printf %03d $i`.nc"
+    i=`expr $i + 1`
+done
+$MPIRUN -np $first_np "$GENDIR/BenchGenerate" $generate_args \
+    "$workdir/bench" >/dev/null || exit 1
+if test $nfiles -gt 1
+then
+    $MPIRUN -np $first_np "$GENDIR/BenchGenerate" $generate_args -n $nfiles \
+        "$workdir/bench_split" >/dev/null || exit 1
+else
+    split=$single
+fi
+set -- $split
+pair="$1 $2"
+if test $nfiles -lt 2
+then
+    pair="$single $single"
+fi
+
+if test ! -s "$output"
+then
+    echo "tool,variant,np,dataset,input_bytes,output_bytes,seconds,throughput_MBps,io_MBps,maxrss_kB,status" >"$output"
+fi
+
+for np in $nprocs
+do
+    for tool in $tools
+    do
+        out="$workdir/$tool.out.nc"
+        # only the variants each tool implements
+        case $tool in
+            pgra) variants="blocking nbio groups" ;;
+            pgea) variants="blocking" ;;
+            *) variants="blocking nbio" ;;
+        esac
+        for variant in $variants
+        do
+            # two groups need two processes and two input files
+            if test $variant = groups \
+                && { test $np -lt 2 || test $nfiles -lt 2; }
+            then
+                continue
+            fi
+            case $tool in
+                pgra) run $tool $variant $np "$out" $split ;;
+                pgwa) run $tool $variant $np "$out" -a layers $single ;;
+                pgsub) run $tool $variant $np "$out" -b 20,-20,170,150 $single ;;
+                pgrcat|pgecat) run $tool $variant $np "$out" $split ;;
+                pgea) run $tool $variant $np "$out" $pair ;;
+                pgbo) run $tool $variant $np "$out" -y sbt $pair ;;
+                *) run $tool $variant $np "$out" $single ;;
+            esac
+        done
+    done
+done
+
+if test $keep = no
+then
+    rm -f $single $split "$workdir/maxrss" "$workdir"/*.log
+    rmdir "$workdir" 2>/dev/null
+fi
+exit 0